@@ -0,0 +1,92 @@
+/**
+ * @file bench_startup.cpp
+ * @brief Startup benchmark for the Linux File Manager.
+ *
+ * Measures time-to-first-frame and time-to-interactive of the text-based user interface,
+ * and compares them with a blocking listing of the same directory.
+ *
+ * @section USAGE
+ * $ ./bench_startup [path]
+ *
+ * If no path is given, a temporary directory with many entries is created and removed afterwards.
+ * The interface is drawn to /dev/null, so results are printed to stderr.
+ */
+
+#include <iostream> // for reporting results
+#include <fstream> // for creating test files
+#include <filesystem> // for file system operations
+#include <chrono> // for timing
+#include <cstdio> // for std::freopen
+#include <cstdlib> // for setenv
+#include <ncurses.h> // for ungetch
+
+#include "../src/core/FileManager.h" // include the FileManager class
+#include "../src/tui/TUI.h" // include the TUI class
+
+namespace fs = std::filesystem;
+namespace core = linux_file_manager::core;
+namespace tui = linux_file_manager::tui;
+
+using Clock = std::chrono::steady_clock;
+
+constexpr int kGeneratedEntries = 20000; // Number of files in the generated directory
+constexpr double kTargetMs = 50.0; // Target for time-to-first-frame and time-to-interactive
+
+// Convert a duration to milliseconds
+template <typename Duration>
+static double toMs(Duration duration) {
+  return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+int main(int argc, char *argv[]) {
+  // Use the given directory or generate one
+  fs::path benchRoot = fs::temp_directory_path() / "lfm_bench_startup";
+  fs::path path = argc > 1 ? fs::path(argv[1]) : benchRoot / "entries";
+  fs::remove_all(benchRoot);
+  if (argc <= 1) {
+    fs::create_directories(path);
+    for (int i = 0; i < kGeneratedEntries; ++i) {
+      std::ofstream(path / ("file_" + std::to_string(i) + ".txt")) << i;
+    }
+  }
+
+  // Keep the benchmark from touching the user's size cache
+  fs::create_directories(benchRoot / "cache");
+  setenv("XDG_CACHE_HOME", (benchRoot / "cache").c_str(), 1);
+
+  // Draw the interface to /dev/null so the benchmark can run without a terminal
+  setenv("TERM", "xterm", 0);
+  if (!std::freopen("/dev/null", "w", stdout)) {
+    std::cerr << "Failed to redirect stdout" << std::endl;
+    return 1;
+  }
+
+  // Staged startup: quit once the first listing has been drawn, at the next input poll
+  tui::TUI::StartupTimings timings;
+  {
+    tui::TUI interface;
+    interface.setFirstListingCallback([]() { ungetch('q'); });
+    interface.run(path.string());
+    timings = interface.startupTimings();
+  }
+
+  // Blocking startup: full canonical listing followed by the size of the first entry
+  auto blockingStart = Clock::now();
+  auto contents = core::FileManager::listDirectory(fs::canonical(path).string());
+  if (!contents.empty()) {
+    core::FileManager::size(contents.front());
+  }
+  auto blockingTime = Clock::now() - blockingStart;
+
+  std::cerr << "Directory:              " << path.string() << " (" << contents.size() << " entries)" << std::endl;
+  std::cerr << "Time to first frame:    " << toMs(timings.firstFrame) << " ms" << std::endl;
+  std::cerr << "Time to first listing:  " << toMs(timings.firstListing) << " ms" << std::endl;
+  std::cerr << "Time to interactive:    " << toMs(timings.interactive) << " ms" << std::endl;
+  std::cerr << "Blocking listing:       " << toMs(blockingTime) << " ms" << std::endl;
+  std::cerr << "Target (" << kTargetMs << " ms):         "
+            << (toMs(timings.firstFrame) <= kTargetMs && toMs(timings.interactive) <= kTargetMs ? "met" : "missed")
+            << std::endl;
+
+  fs::remove_all(benchRoot); // Remove the generated directory and cache
+  return 0;
+}
@@ -0,0 +1,509 @@
+#include <iostream> // for error reporting
+#include <sstream> // for parsing manifest lines
+#include <filesystem> // for relative paths
+#include <algorithm> // for std::sort and std::min
+#include <atomic> // for the shared task index
+#include <chrono> // for timing
+#include <thread> // for the worker threads
+#include <unordered_map> // for looking up manifest entries
+#include <unordered_set> // for looking up unreadable directories
+#include <utility> // for std::pair
+
+#include <fcntl.h> // for open and posix_fadvise
+#include <sys/stat.h> // for stat
+#include <unistd.h> // for pread and close
+
+#include "Checksum.h" // include the Checksum class
+#include "FileManager.h" // include the FileManager class
+#include "../utils/hash.h" // include the hash functions
+
+namespace fs = std::filesystem;
+namespace utils = linux_file_manager::utils;
+
+namespace linux_file_manager {
+namespace core {
+
+namespace {
+
+constexpr const char* kManifestHeader = "# lfm-manifest 1 xxh64-tree"; // First line of a manifest, followed by the chunk size
+constexpr std::size_t kReadSize = 1024 * 1024; // Bytes read per call
+constexpr std::size_t kBatchFiles = 64; // Maximum number of small files in one task
+constexpr std::uintmax_t kBatchBytes = 16 * 1024 * 1024; // Maximum number of bytes in one task of small files
+
+using Clock = std::chrono::steady_clock;
+
+// A file to be hashed
+struct HashJob {
+  std::string fullPath;        // Path to read
+  std::uintmax_t size = 0;     // Expected size
+  std::uint64_t fastHash = 0;  // Result: XXH64 tree hash
+  std::string sha256;          // Result: SHA-256, if requested
+  bool failed = false;         // Result: whether the file could not be read
+};
+
+// A unit of work for the thread pool
+struct HashTask {
+  std::size_t job;     // First job of a batch, or the job a chunk belongs to
+  std::size_t count;   // Number of jobs in a batch, 0 for a chunk
+  std::size_t chunk;   // Chunk index
+};
+
+// Feed a chunk hash into a tree hash in little-endian order
+void addChunkHash(utils::Xxh64& treeHash, std::uint64_t chunkHash) {
+  unsigned char bytes[8];
+  for (int i = 0; i < 8; ++i) {
+    bytes[i] = static_cast<unsigned char>(chunkHash >> (8 * i));
+  }
+  treeHash.update(bytes, sizeof(bytes));
+}
+
+// Read exactly length bytes at offset, failing if the file is shorter than expected
+bool readFully(int fd, char* buffer, std::size_t length, std::uintmax_t offset) {
+  while (length > 0) {
+    ssize_t n = pread(fd, buffer, length, static_cast<off_t>(offset));
+    if (n <= 0) {
+      return false;
+    }
+    buffer += n;
+    length -= static_cast<std::size_t>(n);
+    offset += static_cast<std::uintmax_t>(n);
+  }
+  return true;
+}
+
+// Open a file for a single sequential pass
+int openForReading(const std::string& path) {
+  int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd >= 0) {
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL); // Ask for aggressive readahead
+  }
+  return fd;
+}
+
+// Hash a whole file in order, computing both the fast hash and optionally SHA-256
+void hashSequential(HashJob& job, bool sha256, std::vector<char>& buffer) {
+  int fd = openForReading(job.fullPath);
+  if (fd < 0) {
+    job.failed = true;
+    return;
+  }
+
+  utils::Xxh64 chunkHash, treeHash;
+  utils::Sha256 shaHash;
+  std::uintmax_t offset = 0;
+  std::uintmax_t chunkFill = 0;
+  while (offset < job.size) {
+    std::size_t length = static_cast<std::size_t>(
+        std::min<std::uintmax_t>({buffer.size(), job.size - offset, Checksum::kChunkSize - chunkFill}));
+    if (!readFully(fd, buffer.data(), length, offset)) {
+      job.failed = true;
+      break;
+    }
+    chunkHash.update(buffer.data(), length);
+    if (sha256) {
+      shaHash.update(buffer.data(), length);
+    }
+    offset += length;
+    chunkFill += length;
+
+    // Start the next chunk
+    if (chunkFill == Checksum::kChunkSize && offset < job.size) {
+      addChunkHash(treeHash, chunkHash.digest());
+      chunkHash = utils::Xxh64();
+      chunkFill = 0;
+    }
+  }
+  close(fd);
+
+  if (job.failed) {
+    return;
+  }
+  if (job.size <= Checksum::kChunkSize) {
+    job.fastHash = chunkHash.digest(); // A single chunk is hashed directly
+  } else {
+    addChunkHash(treeHash, chunkHash.digest());
+    job.fastHash = treeHash.digest();
+  }
+  if (sha256) {
+    job.sha256 = shaHash.hexDigest();
+  }
+}
+
+// Hash one chunk of a large file
+bool hashChunk(const HashJob& job, std::size_t chunk, std::vector<char>& buffer, std::uint64_t& result) {
+  int fd = openForReading(job.fullPath);
+  if (fd < 0) {
+    return false;
+  }
+
+  utils::Xxh64 chunkHash;
+  std::uintmax_t offset = chunk * Checksum::kChunkSize;
+  std::uintmax_t end = std::min(job.size, offset + Checksum::kChunkSize);
+  bool ok = true;
+  while (offset < end) {
+    std::size_t length = static_cast<std::size_t>(std::min<std::uintmax_t>(buffer.size(), end - offset));
+    if (!readFully(fd, buffer.data(), length, offset)) {
+      ok = false;
+      break;
+    }
+    chunkHash.update(buffer.data(), length);
+    offset += length;
+  }
+  close(fd);
+
+  result = chunkHash.digest();
+  return ok;
+}
+
+// Hash all jobs with a pool of threads
+void hashJobs(std::vector<HashJob>& jobs, bool sha256, unsigned threads) {
+  // Large files are split into chunks unless SHA-256 needs them read in order
+  std::vector<std::vector<std::uint64_t>> chunkHashes(jobs.size());
+  std::vector<std::vector<char>> chunkOk(jobs.size());
+  std::vector<HashTask> tasks;
+  for (std::size_t i = 0; i < jobs.size(); ++i) {
+    if (jobs[i].size > Checksum::kChunkSize && !sha256) {
+      std::size_t chunks = static_cast<std::size_t>((jobs[i].size + Checksum::kChunkSize - 1) / Checksum::kChunkSize);
+      chunkHashes[i].resize(chunks);
+      chunkOk[i].resize(chunks);
+      for (std::size_t c = 0; c < chunks; ++c) {
+        tasks.push_back({i, 0, c});
+      }
+    } else if (jobs[i].size > Checksum::kChunkSize) {
+      tasks.push_back({i, 1, 0});
+    }
+  }
+
+  // Small files are grouped into batches, after the large files so that those do not finish last
+  for (std::size_t i = 0; i < jobs.size();) {
+    std::size_t count = 0;
+    std::uintmax_t bytes = 0;
+    std::size_t first = i;
+    while (i < jobs.size() && jobs[i].size <= Checksum::kChunkSize && count < kBatchFiles && bytes < kBatchBytes) {
+      bytes += jobs[i].size;
+      ++count;
+      ++i;
+    }
+    if (count > 0) {
+      tasks.push_back({first, count, 0});
+    } else {
+      ++i; // Large file, already scheduled
+    }
+  }
+
+  // Run the tasks
+  std::atomic<std::size_t> nextTask{0};
+  auto worker = [&]() {
+    std::vector<char> buffer(kReadSize);
+    for (std::size_t t = nextTask++; t < tasks.size(); t = nextTask++) {
+      const HashTask& task = tasks[t];
+      if (task.count == 0) {
+        chunkOk[task.job][task.chunk] = hashChunk(jobs[task.job], task.chunk, buffer, chunkHashes[task.job][task.chunk]);
+      } else {
+        for (std::size_t j = task.job; j < task.job + task.count; ++j) {
+          hashSequential(jobs[j], sha256, buffer);
+        }
+      }
+    }
+  };
+
+  if (threads == 0) {
+    threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+  std::vector<std::thread> pool;
+  for (unsigned i = 1; i < threads && i < tasks.size(); ++i) {
+    pool.emplace_back(worker);
+  }
+  worker(); // The calling thread works too
+  for (auto& thread : pool) {
+    thread.join();
+  }
+
+  // Combine the chunk hashes of large files
+  for (std::size_t i = 0; i < jobs.size(); ++i) {
+    if (chunkHashes[i].empty()) {
+      continue;
+    }
+    utils::Xxh64 treeHash;
+    for (std::size_t c = 0; c < chunkHashes[i].size(); ++c) {
+      jobs[i].failed = jobs[i].failed || !chunkOk[i][c];
+      addChunkHash(treeHash, chunkHashes[i][c]);
+    }
+    jobs[i].fastHash = treeHash.digest();
+  }
+}
+
+// Get the relative path, size and mtime of every regular file in a tree, and the relative paths that could not be read
+std::vector<ManifestEntry> scanTree(const std::string& root, const std::vector<std::string>& exclude,
+                                    std::vector<std::string>& failures) {
+  std::vector<ManifestEntry> entries;
+  fs::path rootPath(root);
+  auto relative = [&](const std::string& path) { return fs::path(path).lexically_relative(rootPath).generic_string(); };
+
+  // Identify excluded files by device and inode, so that they match however their path is spelled
+  std::vector<std::pair<dev_t, ino_t>> excluded;
+  for (const auto& path : exclude) {
+    struct stat info;
+    if (stat(path.c_str(), &info) == 0) {
+      excluded.emplace_back(info.st_dev, info.st_ino);
+    }
+  }
+
+  FileManager::walk(root, [&](const std::string& path) {
+    struct stat info;
+    if (stat(path.c_str(), &info) != 0) {
+      std::cerr << "\nError reading file status: " << path << std::endl;
+      failures.push_back(relative(path));
+      return;
+    }
+    if (std::find(excluded.begin(), excluded.end(), std::make_pair(info.st_dev, info.st_ino)) != excluded.end()) {
+      return;
+    }
+    ManifestEntry entry;
+    entry.path = relative(path);
+    entry.size = static_cast<std::uintmax_t>(info.st_size);
+    entry.mtime = static_cast<std::int64_t>(info.st_mtim.tv_sec) * 1000000000 + info.st_mtim.tv_nsec;
+    entries.push_back(std::move(entry));
+  }, [&](const std::string& path, const std::string&) {
+    failures.push_back(relative(path));
+  });
+  return entries;
+}
+
+// Check whether a field is a lowercase hex string of the given length
+bool isHex(const std::string& field, std::size_t length) {
+  return field.size() == length && field.find_first_not_of("0123456789abcdef") == std::string::npos;
+}
+
+// Check whether a relative path is one of the failed paths or lies below one of them
+bool isUnderFailure(const std::string& path, const std::unordered_set<std::string>& failures) {
+  if (failures.count(".") || failures.count(path)) {
+    return true; // The root itself or this exact path could not be read
+  }
+  for (std::size_t slash = path.find('/'); slash != std::string::npos; slash = path.find('/', slash + 1)) {
+    if (failures.count(path.substr(0, slash))) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Escape backslashes and newlines so that each manifest entry stays on one line
+std::string escapePath(const std::string& path) {
+  std::string escaped;
+  escaped.reserve(path.size());
+  for (char c : path) {
+    if (c == '\\') {
+      escaped += "\\\\";
+    } else if (c == '\n') {
+      escaped += "\\n";
+    } else {
+      escaped += c;
+    }
+  }
+  return escaped;
+}
+
+std::string unescapePath(const std::string& escaped) {
+  std::string path;
+  path.reserve(escaped.size());
+  for (std::size_t i = 0; i < escaped.size(); ++i) {
+    if (escaped[i] == '\\' && i + 1 < escaped.size()) {
+      ++i;
+      path += escaped[i] == 'n' ? '\n' : escaped[i];
+    } else {
+      path += escaped[i];
+    }
+  }
+  return path;
+}
+
+double secondsSince(Clock::time_point start) {
+  return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+} // namespace
+
+double ChecksumStats::gigabytesPerSecond() const {
+  return seconds > 0 ? static_cast<double>(bytes) / 1e9 / seconds : 0;
+}
+
+bool VerifyReport::ok() const {
+  return modified.empty() && missing.empty() && added.empty() && unreadable.empty();
+}
+
+std::vector<ManifestEntry> Checksum::hashTree(const std::string& root, const ChecksumOptions& options,
+                                              ChecksumStats& stats) {
+  auto start = Clock::now();
+  stats = ChecksumStats();
+  std::vector<std::string> failures;
+  std::vector<ManifestEntry> entries = scanTree(root, options.exclude, failures);
+  stats.errors += failures.size(); // Skipped directories make the manifest incomplete
+
+  // Hash every file
+  std::vector<HashJob> jobs(entries.size());
+  for (std::size_t i = 0; i < entries.size(); ++i) {
+    jobs[i].fullPath = (fs::path(root) / entries[i].path).string();
+    jobs[i].size = entries[i].size;
+  }
+  hashJobs(jobs, options.sha256, options.threads);
+
+  // Keep the files that could be read
+  std::vector<ManifestEntry> manifest;
+  manifest.reserve(entries.size());
+  for (std::size_t i = 0; i < entries.size(); ++i) {
+    if (jobs[i].failed) {
+      std::cerr << "\nError reading file: " << jobs[i].fullPath << std::endl;
+      ++stats.errors;
+      continue;
+    }
+    entries[i].fastHash = jobs[i].fastHash;
+    entries[i].sha256 = std::move(jobs[i].sha256);
+    ++stats.files;
+    stats.bytes += entries[i].size;
+    manifest.push_back(std::move(entries[i]));
+  }
+
+  std::sort(manifest.begin(), manifest.end(),
+            [](const ManifestEntry& a, const ManifestEntry& b) { return a.path < b.path; });
+  stats.seconds = secondsSince(start);
+  return manifest;
+}
+
+VerifyReport Checksum::verifyTree(const std::string& root, const std::vector<ManifestEntry>& manifest,
+                                  const ChecksumOptions& options, ChecksumStats& stats) {
+  auto start = Clock::now();
+  stats = ChecksumStats();
+  VerifyReport report;
+
+  // Index the current tree by relative path
+  std::vector<std::string> failures;
+  std::unordered_map<std::string, ManifestEntry> current;
+  for (auto& entry : scanTree(root, options.exclude, failures)) {
+    std::string path = entry.path;
+    current.emplace(std::move(path), std::move(entry));
+  }
+
+  // Directories that could not be walked are reported as unreadable
+  std::unordered_set<std::string> failedPaths(failures.begin(), failures.end());
+  report.unreadable.assign(failedPaths.begin(), failedPaths.end());
+  stats.errors += failedPaths.size();
+
+  // Decide which files need to be reread
+  bool sha256 = options.sha256;
+  std::vector<const ManifestEntry*> expected;
+  for (const auto& entry : manifest) {
+    auto it = current.find(entry.path);
+    if (it == current.end()) {
+      // Files below a directory that could not be read are covered by its unreadable entry
+      if (!isUnderFailure(entry.path, failedPaths)) {
+        report.missing.push_back(entry.path);
+      }
+      continue;
+    }
+    const ManifestEntry& actual = it->second;
+    if (actual.size != entry.size) {
+      report.modified.push_back(entry.path); // No need to read a file whose size has changed
+    } else if (actual.mtime == entry.mtime && !options.full) {
+      ++report.unchanged;
+    } else {
+      expected.push_back(&entry);
+      sha256 = sha256 || !entry.sha256.empty();
+    }
+    current.erase(it);
+  }
+  for (const auto& [path, entry] : current) {
+    report.added.push_back(path);
+  }
+
+  // Rehash and compare
+  std::vector<HashJob> jobs(expected.size());
+  for (std::size_t i = 0; i < expected.size(); ++i) {
+    jobs[i].fullPath = (fs::path(root) / expected[i]->path).string();
+    jobs[i].size = expected[i]->size;
+  }
+  hashJobs(jobs, sha256, options.threads);
+  for (std::size_t i = 0; i < jobs.size(); ++i) {
+    const ManifestEntry& entry = *expected[i];
+    if (jobs[i].failed) {
+      report.unreadable.push_back(entry.path);
+      ++stats.errors;
+      continue;
+    }
+    ++stats.files;
+    stats.bytes += entry.size;
+    if (jobs[i].fastHash != entry.fastHash || (!entry.sha256.empty() && jobs[i].sha256 != entry.sha256)) {
+      report.modified.push_back(entry.path);
+    } else {
+      ++report.matched;
+    }
+  }
+
+  for (auto* list : {&report.modified, &report.missing, &report.added, &report.unreadable}) {
+    std::sort(list->begin(), list->end());
+  }
+  stats.seconds = secondsSince(start);
+  return report;
+}
+
+bool Checksum::writeManifest(std::ostream& out, const std::vector<ManifestEntry>& entries) {
+  // One line per file: fast hash, SHA-256 (or "-"), size, mtime and the escaped path
+  out << kManifestHeader << ' ' << kChunkSize << '\n';
+  for (const auto& entry : entries) {
+    out << utils::toHex(entry.fastHash) << ' ' << (entry.sha256.empty() ? "-" : entry.sha256) << ' ' << entry.size
+        << ' ' << entry.mtime << ' ' << escapePath(entry.path) << '\n';
+  }
+  out.flush();
+
+  if (!out) {
+    std::cerr << "\nError writing manifest" << std::endl;
+    return false;
+  }
+  return true;
+}
+
+bool Checksum::readManifest(std::istream& in, std::vector<ManifestEntry>& entries) {
+  entries.clear();
+
+  // Check the format and chunk size
+  std::string line;
+  std::string expectedHeader = std::string(kManifestHeader) + ' ' + std::to_string(kChunkSize);
+  if (!std::getline(in, line) || line != expectedHeader) {
+    std::cerr << "\nUnsupported manifest format: " << line << std::endl;
+    return false;
+  }
+
+  std::unordered_set<std::string> seenPaths;
+  for (std::size_t lineNumber = 2; std::getline(in, line); ++lineNumber) {
+    if (line.empty()) {
+      continue;
+    }
+
+    std::istringstream fields(line);
+    std::string fastHash;
+    ManifestEntry entry;
+    fields >> fastHash >> entry.sha256 >> entry.size >> entry.mtime;
+    if (!fields || fields.get() != ' ' || !isHex(fastHash, 16) ||
+        (entry.sha256 != "-" && !isHex(entry.sha256, 64))) {
+      std::cerr << "\nInvalid manifest entry on line " << lineNumber << std::endl;
+      return false;
+    }
+    entry.fastHash = std::stoull(fastHash, nullptr, 16);
+    if (entry.sha256 == "-") {
+      entry.sha256.clear();
+    }
+    std::string path;
+    std::getline(fields, path);
+    entry.path = unescapePath(path);
+    if (!seenPaths.insert(entry.path).second) {
+      std::cerr << "\nDuplicate manifest entry on line " << lineNumber << ": " << entry.path << std::endl;
+      return false;
+    }
+    entries.push_back(std::move(entry));
+  }
+
+  return true;
+}
+
+} // namespace core
+} // namespace linux_file_manager
@@ -0,0 +1,124 @@
+#ifndef CHECKSUM_H
+#define CHECKSUM_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <iosfwd>
+
+namespace linux_file_manager {
+namespace core {
+
+/**
+ * @brief A file entry in a checksum manifest
+ */
+struct ManifestEntry {
+  std::string path;           // Path relative to the tree root
+  std::uintmax_t size = 0;    // File size in bytes
+  std::int64_t mtime = 0;     // Last modification time in nanoseconds since the epoch
+  std::uint64_t fastHash = 0; // XXH64 tree hash of the contents
+  std::string sha256;         // SHA-256 of the contents as hex, empty if not computed
+};
+
+/**
+ * @brief Options for hashing and verifying a tree
+ */
+struct ChecksumOptions {
+  bool sha256 = false;  // Also compute SHA-256 (always on when verifying a manifest that has it)
+  bool full = false;    // When verifying, rehash files even if their size and mtime are unchanged
+  unsigned threads = 0; // Number of worker threads, 0 for one per hardware thread
+  std::vector<std::string> exclude; // Files left out of the tree, such as the manifest itself, matched by device and inode
+};
+
+/**
+ * @brief Statistics of a hashing run
+ */
+struct ChecksumStats {
+  std::uintmax_t files = 0;  // Number of files hashed
+  std::uintmax_t bytes = 0;  // Number of bytes hashed
+  std::uintmax_t errors = 0; // Number of files and directories that could not be read
+  double seconds = 0;        // Wall time of the whole run, including the walk
+
+  /**
+   * @brief Get the hashing throughput
+   * @return The throughput in gigabytes (10^9 bytes) per second
+   */
+  double gigabytesPerSecond() const;
+};
+
+/**
+ * @brief The result of verifying a tree against a manifest
+ */
+struct VerifyReport {
+  std::uintmax_t matched = 0;         // Files rehashed with matching checksums
+  std::uintmax_t unchanged = 0;       // Files skipped because their size and mtime match the manifest
+  std::vector<std::string> modified;  // Files whose size or checksum differs from the manifest
+  std::vector<std::string> missing;   // Files in the manifest but not in the tree
+  std::vector<std::string> added;     // Files in the tree but not in the manifest
+  std::vector<std::string> unreadable; // Files and directories that could not be read
+
+  /**
+   * @brief Check whether the tree matches the manifest
+   * @return True if no file was modified, missing, added or unreadable
+   */
+  bool ok() const;
+};
+
+/**
+ * @brief A class for computing and verifying checksums of directory trees
+ * @details Files are found with FileManager::walk and hashed by a pool of threads. Small files are hashed in
+ * batches, one file per thread at a time, while large files are split into chunks that are hashed in parallel.
+ * The fast hash of a file is the XXH64 of its contents if it fits in one chunk, and otherwise the XXH64 of the
+ * little-endian XXH64s of its chunks, so it does not depend on how the file was scheduled. SHA-256 needs the
+ * contents in order, so a large file is read by a single thread when it is requested.
+ */
+class Checksum {
+public:
+  static constexpr std::uintmax_t kChunkSize = 4 * 1024 * 1024; // Chunk size of the fast hash
+
+  /**
+   * @brief Hash every regular file in a tree
+   * @details Files and directories that could not be read are left out of the manifest and counted in stats.errors.
+   * @param root The path to the root directory
+   * @param options The hashing options
+   * @param stats Filled with the statistics of the run
+   * @return The manifest entries, sorted by path
+   */
+  static std::vector<ManifestEntry> hashTree(const std::string& root, const ChecksumOptions& options,
+                                             ChecksumStats& stats);
+
+  /**
+   * @brief Verify a tree against a manifest
+   * @details Files whose size and mtime match the manifest are not reread unless options.full is set. A directory
+   * that cannot be walked is reported as unreadable instead of listing every file below it as missing.
+   * @param root The path to the root directory
+   * @param manifest The manifest entries to check against
+   * @param options The verification options
+   * @param stats Filled with the statistics of the run
+   * @return The verification report, with each list sorted by path
+   */
+  static VerifyReport verifyTree(const std::string& root, const std::vector<ManifestEntry>& manifest,
+                                 const ChecksumOptions& options, ChecksumStats& stats);
+
+  /**
+   * @brief Write a manifest
+   * @param out The stream to write to
+   * @param entries The manifest entries
+   * @return True if the manifest was written successfully, false otherwise
+   */
+  static bool writeManifest(std::ostream& out, const std::vector<ManifestEntry>& entries);
+
+  /**
+   * @brief Read a manifest
+   * @details The whole manifest is rejected if a line has a malformed hash or repeats the path of an earlier line.
+   * @param in The stream to read from
+   * @param entries Filled with the manifest entries
+   * @return True if the manifest was read successfully, false otherwise
+   */
+  static bool readManifest(std::istream& in, std::vector<ManifestEntry>& entries);
+};
+
+} // namespace core
+} // namespace linux_file_manager
+
+#endif // CHECKSUM_H
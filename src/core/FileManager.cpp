@@ -2,6 +2,8 @@
 #include <filesystem> // for file system operations
 #include <cstdint> // for std::uintmax_t
 #include <unordered_map> // for std::unordered_map
+#include <mutex> // for std::mutex
+#include <future> // for std::future and std::async
 
 #include "FileManager.h" // include the FileManager class
 #include "../utils/utils.h" // include the SizeCache struct and utility functions
@@ -14,6 +16,43 @@ namespace core {
 
 // Global cache for directory sizes
 std::unordered_map<std::string, utils::SizeCache> sizeCache;
+std::mutex sizeCacheMutex; // guards sizeCache and pendingSizeCache
+std::future<std::unordered_map<std::string, utils::SizeCache>> pendingSizeCache; // persisted cache being loaded in the background
+
+// Hand an error message to the caller if it asked for one, otherwise print it
+static void reportError(std::string* error, const std::string& message) {
+  if (error) {
+    *error = message;
+  } else {
+    std::cerr << "\n" << message << std::endl;
+  }
+}
+
+// Merge the persisted cache into sizeCache once it has been loaded (caller must not hold sizeCacheMutex)
+static void mergePendingSizeCache() {
+  std::future<std::unordered_map<std::string, utils::SizeCache>> pending;
+  {
+    std::lock_guard<std::mutex> lock(sizeCacheMutex);
+    if (!pendingSizeCache.valid()) {
+      return; // nothing to merge
+    }
+    pending = std::move(pendingSizeCache);
+  }
+
+  // Wait for the load without holding the lock
+  std::unordered_map<std::string, utils::SizeCache> loaded;
+  try {
+    loaded = pending.get();
+  } catch (const std::exception&) {
+    return; // Runs while the TUI is drawn, so a cache that cannot be loaded is dropped quietly
+  }
+
+  // Entries computed during this session are fresher than the persisted ones, so do not overwrite them
+  std::lock_guard<std::mutex> lock(sizeCacheMutex);
+  for (auto& [key, entry] : loaded) {
+    sizeCache.emplace(key, entry);
+  }
+}
 
 std::vector<std::string> FileManager::listDirectory(const std::string& path) {
   // Create a vector to store the names of the files and directories within the directory specified by the path
@@ -34,6 +73,36 @@ std::vector<std::string> FileManager::listDirectory(const std::string& path) {
   return contents; // return the vector of contents
 }
 
+bool FileManager::listDirectory(const std::string& path, std::size_t batchSize,
+                                const std::function<bool(const std::vector<std::string>&)>& onBatch,
+                                std::string* error) {
+  std::vector<std::string> batch;
+  batch.reserve(batchSize);
+
+  // Try to iterate over the contents of the directory
+  try {
+    // Entries are reported as they are read, without resolving each one, so that the first batch is available quickly
+    for (const auto& entry : fs::directory_iterator(path)) {
+      batch.push_back(entry.path().string());
+      if (batch.size() >= batchSize) {
+        if (!onBatch(batch)) {
+          return false; // Stopped by the caller
+        }
+        batch.clear();
+      }
+    }
+  } catch (const fs::filesystem_error& e) {
+    // If an error occurs, report it
+    reportError(error, std::string("Error listing directory contents: ") + e.what());
+  }
+
+  // Report the remaining entries
+  if (!batch.empty()) {
+    return onBatch(batch);
+  }
+  return true;
+}
+
 bool FileManager::exists(const std::string& path) {
   // Check if the file or directory exists
   return fs::exists(path);
@@ -77,7 +146,7 @@ bool FileManager::deletePath(const std::string& path) {
   return false; // return false if an error occurred
 }
 
-std::uintmax_t FileManager::size(const std::string& path) {
+std::uintmax_t FileManager::size(const std::string& path, const std::atomic<bool>* cancel, std::string* error) {
   // Try to get the size of the file or directory
   try {
     // Skip problematic paths (e.g., symbolic links or special files, like /dev/null, /proc, /sys, etc.)
@@ -93,32 +162,115 @@ std::uintmax_t FileManager::size(const std::string& path) {
       auto lastWriteTime = fs::last_write_time(path); // Get the last write time of the directory
 
       // Check if the directory size is already cached
-      auto cacheIt = sizeCache.find(path); // Search for the path in the cache
-      if (cacheIt != sizeCache.end() && cacheIt->second.time == lastWriteTime) {
-        return cacheIt->second.size; // Return cached size if unchanged
+      mergePendingSizeCache(); // Make sure the persisted cache is available
+      {
+        std::lock_guard<std::mutex> lock(sizeCacheMutex);
+        auto cacheIt = sizeCache.find(path); // Search for the path in the cache
+        if (cacheIt != sizeCache.end() && cacheIt->second.time == lastWriteTime) {
+          return cacheIt->second.size; // Return cached size if unchanged
+        }
       }
 
       // Calculate the size of the directory otherwise
       std::uintmax_t total_size = 0;
       for (const auto& entry : fs::recursive_directory_iterator(path)) {
+        if (cancel && cancel->load()) {
+          return 0; // Stop early and leave the cache untouched if the caller no longer needs the result
+        }
         if (fs::is_regular_file(entry.path())) {
           total_size += fs::file_size(entry.path());
         }
       }
 
       // Update the cache with the new size
+      std::lock_guard<std::mutex> lock(sizeCacheMutex);
       sizeCache[path] = {total_size, lastWriteTime};
 
       return total_size; // Return the total size of the directory
     }
 
   } catch (const fs::filesystem_error& e) {
-    // If an error occurs, print an error message and return 0
-    std::cerr << "\nError getting file or directory size: " << e.what() << std::endl;
+    // If an error occurs, report it and return 0
+    reportError(error, std::string("Error getting file or directory size: ") + e.what());
   }
 
   return 0; // return 0 by default or if an error occurred
 }
 
+bool FileManager::walk(const std::string& path, const std::function<void(const std::string&)>& onFile,
+                       const std::function<void(const std::string&, const std::string&)>& onError) {
+  bool complete = true;
+
+  // Report a directory that could not be read completely
+  auto fail = [&](const std::string& dir, const std::error_code& ec) {
+    std::cerr << "\nError walking directory " << dir << ": " << ec.message() << std::endl;
+    if (onError) {
+      onError(dir, ec.message());
+    }
+    complete = false;
+  };
+
+  // Walk the tree depth first, one directory at a time so that every failure can be attributed to a directory
+  std::vector<fs::path> pending{fs::path(path)};
+  while (!pending.empty()) {
+    fs::path dir = std::move(pending.back());
+    pending.pop_back();
+
+    std::error_code ec;
+    fs::directory_iterator it(dir, ec);
+    if (ec) {
+      fail(dir.string(), ec);
+      continue;
+    }
+    for (; it != fs::directory_iterator(); it.increment(ec)) {
+      // Skip symbolic links and special files
+      std::error_code statusEc;
+      fs::file_status status = it->symlink_status(statusEc);
+      if (statusEc) {
+        fail(it->path().string(), statusEc);
+      } else if (fs::is_directory(status)) {
+        pending.push_back(it->path());
+      } else if (fs::is_regular_file(status)) {
+        onFile(it->path().string());
+      }
+    }
+    if (ec) {
+      fail(dir.string(), ec); // Reading the directory failed partway through
+    }
+  }
+
+  return complete;
+}
+
+void FileManager::loadSizeCacheAsync(const std::string& cachePath) {
+  mergePendingSizeCache(); // Merge any earlier load before starting a new one
+  std::lock_guard<std::mutex> lock(sizeCacheMutex);
+
+  // Read the cache file on a background thread; it is merged the first time a directory size is needed
+  pendingSizeCache = std::async(std::launch::async, [cachePath]() {
+    if (!fs::exists(cachePath)) {
+      return std::unordered_map<std::string, utils::SizeCache>(); // No cache has been saved yet
+    }
+    std::string error; // The TUI is drawn while this runs, so a missing or corrupt cache is ignored quietly
+    return utils::loadSizeCache(cachePath, &error);
+  });
+}
+
+bool FileManager::saveSizeCache(const std::string& cachePath, std::string* error) {
+  mergePendingSizeCache(); // Keep persisted entries that were not used during this session
+  std::lock_guard<std::mutex> lock(sizeCacheMutex);
+
+  // Try to create the directory holding the cache file
+  try {
+    fs::create_directories(fs::path(cachePath).parent_path());
+  } catch (const fs::filesystem_error& e) {
+    // If an error occurs, report it and give up
+    reportError(error, std::string("Error creating cache directory: ") + e.what());
+    return false;
+  }
+
+  return utils::saveSizeCache(cachePath, sizeCache, error);
+}
+
 } // namespace core
 } // namespace linux_file_manager
\ No newline at end of file
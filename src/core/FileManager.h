@@ -4,6 +4,9 @@
 #include <string>
 #include <vector>
 #include <cstdint>
+#include <cstddef>
+#include <atomic>
+#include <functional>
 
 namespace linux_file_manager {
 namespace core {
@@ -21,6 +24,21 @@ public:
   */
   static std::vector<std::string> listDirectory(const std::string &path);
 
+  /**
+  * @brief List the contents of a directory in batches as they are read
+  * @details Unlike the single-call overload, entries are not resolved to canonical paths, so the first batch is
+  * reported as soon as it has been read from the directory.
+  * @param path The path to the directory
+  * @param batchSize The maximum number of entries passed to each call of onBatch
+  * @param onBatch Called with each batch of full paths to the files and directories in the directory; returns false
+  * to stop listing
+  * @param error If not null, receives the error message instead of it being printed
+  * @return True if the whole directory was listed, false if onBatch stopped it early
+  */
+  static bool listDirectory(const std::string& path, std::size_t batchSize,
+                            const std::function<bool(const std::vector<std::string>&)>& onBatch,
+                            std::string* error = nullptr);
+
   /**
   * @brief Check if a file or directory exists
   * @param path The path to the file or directory
@@ -45,10 +63,45 @@ public:
   /**
   * @brief Get file or directory size
   * @param path The path to the file or directory
+  * @param cancel Optional flag that stops the calculation early (returning 0) once it is set
+  * @param error If not null, receives the error message instead of it being printed
   * @return The size of the file or directory in bytes
   */
-  static std::uintmax_t size(const std::string& path);
-  
+  static std::uintmax_t size(const std::string& path, const std::atomic<bool>* cancel = nullptr,
+                             std::string* error = nullptr);
+
+  /**
+  * @brief Walk a directory tree and visit every regular file
+  * @details Symbolic links and special files are skipped, as in size(). A directory that cannot be opened or read
+  * to the end is reported to onError and the walk carries on with the rest of the tree.
+  * @param path The path to the root directory
+  * @param onFile Called with the full path of each regular file
+  * @param onError Optional, called with the path and error message of each directory or entry that could not be read
+  * @return True if the whole tree was walked, false if anything was skipped
+  */
+  static bool walk(const std::string& path, const std::function<void(const std::string&)>& onFile,
+                   const std::function<void(const std::string&, const std::string&)>& onError = nullptr);
+
+  /**
+  * @brief Start loading the persisted directory size cache in the background
+  * @details The loaded entries are merged into the size cache the first time a directory size is requested.
+  * A cached size is only checked against the directory's own mtime, which does not change when a file nested
+  * deeper in the tree grows or shrinks, so a persisted size can be stale until the directory itself is modified.
+  * Delete the cache file to force all sizes to be recalculated. A missing or corrupt cache file is ignored without
+  * printing anything, since the load runs while the TUI is on screen.
+  * @param cachePath The path to the cache file
+  * @return void
+  */
+  static void loadSizeCacheAsync(const std::string& cachePath);
+
+  /**
+  * @brief Save the directory size cache to disk
+  * @param cachePath The path to the cache file
+  * @param error If not null, receives the error message instead of it being printed
+  * @return True if the cache was saved successfully, false otherwise
+  */
+  static bool saveSizeCache(const std::string& cachePath, std::string* error = nullptr);
+
 };
 
 } // namespace core
@@ -14,7 +14,13 @@
  * This is a simple file manager for Linux systems. It is written in C++ and uses the ncurses library for the user interface.
  * 
  * @section USAGE
- * $ ./lfm
+ * $ ./lfm [path]
+ * $ ./lfm --checksum <dir> [--sha256] [--output <manifest>]
+ * $ ./lfm --verify <dir> <manifest> [--full]
+ *
+ * --checksum writes a sorted manifest of every regular file under <dir> (to stdout unless --output is given).
+ * --verify checks <dir> against a manifest, rehashing only files whose size or mtime changed unless --full is given.
+ * Both report throughput on stderr.
  * 
  * @section DEPENDENCIES
  * - ncurses
@@ -31,9 +37,119 @@
 #define __BASIC_MAIN__ // uncomment this line to enable main
 #ifdef __BASIC_MAIN__
 
+#include <iostream> // for reporting results
+#include <fstream> // for manifest files
+
+#include "core/Checksum.h" // include the Checksum class
+
 namespace tui = linux_file_manager::tui;
+namespace core = linux_file_manager::core;
+
+// Print the command-line usage
+static int usage(const char* program) {
+  std::cerr << "Usage: " << program << " [path]" << std::endl;
+  std::cerr << "       " << program << " --checksum <dir> [--sha256] [--output <manifest>]" << std::endl;
+  std::cerr << "       " << program << " --verify <dir> <manifest> [--full]" << std::endl;
+  return 2;
+}
+
+// Print the statistics of a hashing run
+static void printStats(const core::ChecksumStats& stats) {
+  std::cerr << "Hashed " << stats.files << " files, " << static_cast<double>(stats.bytes) / 1e9 << " GB in "
+            << stats.seconds << " s (" << stats.gigabytesPerSecond() << " GB/s)" << std::endl;
+  if (stats.errors > 0) {
+    std::cerr << stats.errors << " files or directories could not be read" << std::endl;
+  }
+}
+
+// Compute a manifest for a tree
+static int runChecksum(int argc, char *argv[]) {
+  core::ChecksumOptions options;
+  std::string outputPath;
+  for (int i = 3; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (arg == "--sha256") {
+      options.sha256 = true;
+    } else if (arg == "--output" && i + 1 < argc) {
+      outputPath = argv[++i];
+    } else {
+      return usage(argv[0]);
+    }
+  }
+
+  // Leave the manifest out if it is written inside the tree and already exists from an earlier run
+  if (!outputPath.empty()) {
+    options.exclude.push_back(outputPath);
+  }
+
+  core::ChecksumStats stats;
+  auto manifest = core::Checksum::hashTree(argv[2], options, stats);
+
+  bool written;
+  if (outputPath.empty()) {
+    written = core::Checksum::writeManifest(std::cout, manifest);
+  } else {
+    std::ofstream outFile(outputPath);
+    if (!outFile) {
+      std::cerr << "Failed to open manifest: " << outputPath << std::endl;
+    }
+    written = outFile && core::Checksum::writeManifest(outFile, manifest);
+  }
+  printStats(stats);
+
+  return written && stats.errors == 0 ? 0 : 1;
+}
+
+// Verify a tree against a manifest
+static int runVerify(int argc, char *argv[]) {
+  core::ChecksumOptions options;
+  for (int i = 4; i < argc; ++i) {
+    if (std::string(argv[i]) == "--full") {
+      options.full = true;
+    } else {
+      return usage(argv[0]);
+    }
+  }
+
+  std::ifstream inFile(argv[3]);
+  std::vector<core::ManifestEntry> manifest;
+  if (!inFile || !core::Checksum::readManifest(inFile, manifest)) {
+    std::cerr << "Failed to read manifest: " << argv[3] << std::endl;
+    return 1;
+  }
+
+  options.exclude.push_back(argv[3]); // The manifest may be stored inside the tree it describes
+
+  core::ChecksumStats stats;
+  auto report = core::Checksum::verifyTree(argv[2], manifest, options, stats);
+  for (const auto& path : report.modified) {
+    std::cout << "MODIFIED " << path << std::endl;
+  }
+  for (const auto& path : report.missing) {
+    std::cout << "MISSING " << path << std::endl;
+  }
+  for (const auto& path : report.added) {
+    std::cout << "ADDED " << path << std::endl;
+  }
+  for (const auto& path : report.unreadable) {
+    std::cout << "UNREADABLE " << path << std::endl;
+  }
+  std::cerr << report.matched << " matched, " << report.unchanged << " unchanged (skipped)" << std::endl;
+  printStats(stats);
+
+  return report.ok() ? 0 : 1;
+}
 
 int main(int argc, char *argv[]) {
+  // Run the checksum modes without the text-based user interface
+  std::string mode = argc > 1 ? argv[1] : "";
+  if (mode == "--checksum") {
+    return argc > 2 ? runChecksum(argc, argv) : usage(argv[0]);
+  }
+  if (mode == "--verify") {
+    return argc > 3 ? runVerify(argc, argv) : usage(argv[0]);
+  }
+
   // Set the initial path
   std::string path = argc > 1 ? argv[1] : ".";
 
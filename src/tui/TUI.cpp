@@ -3,6 +3,7 @@
 #include <filesystem>
 
 #include "../core/FileManager.h"
+#include "../utils/utils.h"
 #include "TUI.h"
 
 namespace linux_file_manager {
@@ -11,6 +12,13 @@ namespace tui {
 using namespace linux_file_manager::core;
 
 namespace fs = std::filesystem;
+namespace utils = linux_file_manager::utils;
+
+using Clock = std::chrono::steady_clock;
+
+constexpr int kInputPollMs = 50; // How long getch waits before checking for background results
+constexpr std::size_t kListingBatchSize = 256; // Directory entries read between redraws
+constexpr auto kListingRedrawInterval = std::chrono::milliseconds(50); // Minimum time between redraws while listing
 
 TUI::TUI() : selectedIndex(0) {
   initialize();
@@ -26,6 +34,7 @@ void TUI::initialize() {
   noecho();            // Do not echo user input
   keypad(stdscr, TRUE); // Enable keypad input
   curs_set(0);         // Hide the cursor
+  timeout(kInputPollMs); // Return from getch periodically to pick up background results
 
   // Enable colors
   if (has_colors()) {
@@ -46,42 +55,166 @@ void TUI::displayHeader(const std::string& currentPath) {
 }
 
 void TUI::cleanup() {
+  stopSizeWorker(); // Make sure the background thread is not left running
   endwin(); // End the ncurses session
 }
 
 void TUI::run(std::string path) {
+  runStartTime = Clock::now();
+  timings = StartupTimings();
+
   std::string currentPath = std::filesystem::canonical(path).string();
   std::string errorMessage;
 
-  while (true) {
-    try {
-      clear(); // Clear the screen
+  // Draw the interface frame before touching the directory contents
+  directoryContents.clear();
+  render(currentPath, errorMessage);
+  timings.firstFrame = elapsedSinceStart();
 
-      // Refresh the directory contents
-      directoryContents = FileManager::listDirectory(currentPath);
+  // Load the persisted size cache and calculate sizes in the background
+  const std::string cachePath = utils::defaultSizeCachePath();
+  if (!cachePath.empty()) {
+    FileManager::loadSizeCacheAsync(cachePath);
+  }
+  startSizeWorker();
 
-      // Add the parent directory entry if not at the root
-      if (currentPath != "/") {
-        directoryContents.insert(directoryContents.begin(), fs::path(currentPath).parent_path().string());
+  bool reload = true; // Whether the directory contents need to be read
+  bool redraw = true; // Whether the screen needs to be drawn again
+  bool listingComplete = true; // Whether the last listing was read to the end
+  int pendingKey = ERR; // Key that interrupted the listing, handled below
+  while (true) {
+    try {
+      // Refresh the directory contents when the directory changes
+      if (reload) {
+        reload = false;
+        redraw = true;
+        pendingKey = loadDirectory(currentPath, errorMessage);
+        listingComplete = pendingKey == ERR;
       }
 
       // Render the TUI layout
-      displayHeader(currentPath); // Display the header with program information and the current directory
-      displayDirectory(currentPath); // Display the directory pane and file details
-      displayFooter(errorMessage); // Display the footer with error messages and legend keys
+      if (takeSizeUpdate(errorMessage) || redraw) {
+        redraw = false;
+        render(currentPath, errorMessage);
+        if (timings.firstListing.count() == 0) {
+          recordFirstListing(); // An empty directory has no batches to draw
+        }
+      }
+      if (timings.interactive.count() == 0) {
+        timings.interactive = elapsedSinceStart();
+      }
 
       // Get user input and handle it
-      int key = getch();
+      int key = pendingKey != ERR ? pendingKey : getch();
+      pendingKey = ERR;
+      if (key == ERR) {
+        continue; // No input yet, check for background results
+      }
       if (key == 'q') {
         break; // Quit the program
       }
-    
-      currentPath = handleUserInput(currentPath, key);
+
+      std::string nextPath = handleUserInput(currentPath, key);
+      reload = nextPath != currentPath || key == 'r' || !listingComplete; // Finish an interrupted listing
+      redraw = true;
+      currentPath = nextPath;
       errorMessage.clear(); // Clear error messages after successful input handling
     } catch (const std::exception& e) {
       errorMessage = e.what(); // Capture and display any error messages
+      reload = !listingComplete; // Finish an interrupted listing after an error as well
+      redraw = true;
     }
   }
+
+  stopSizeWorker();
+  if (!cachePath.empty()) {
+    // The screen is still in curses mode, and a cache that cannot be saved only means sizes are recalculated
+    std::string saveError;
+    FileManager::saveSizeCache(cachePath, &saveError);
+  }
+}
+
+const TUI::StartupTimings& TUI::startupTimings() const {
+  return timings;
+}
+
+void TUI::render(const std::string& currentPath, const std::string& errorMessage) {
+  erase(); // Clear the screen without forcing a full repaint
+  displayHeader(currentPath); // Display the header with program information and the current directory
+  displayDirectory(currentPath); // Display the directory pane and file details
+  displayFooter(errorMessage); // Display the footer with error messages and legend keys
+  refresh();
+}
+
+int TUI::loadDirectory(const std::string& currentPath, std::string& errorMessage) {
+  directoryContents.clear();
+
+  // Forget sizes from the previous listing so that they are recalculated
+  {
+    std::lock_guard<std::mutex> lock(sizeMutex);
+    sizeResults.clear();
+  }
+
+  // Add the parent directory entry if not at the root
+  if (currentPath != "/") {
+    directoryContents.push_back(fs::path(currentPath).parent_path().string());
+  }
+
+  // Draw the first batch straight away and the rest at a limited rate, polling for input between batches
+  int interruptKey = ERR;
+  auto lastDraw = Clock::time_point();
+  std::string listError;
+  timeout(0); // Do not wait for input while listing
+  FileManager::listDirectory(currentPath, kListingBatchSize, [&](const std::vector<std::string>& batch) {
+    directoryContents.insert(directoryContents.end(), batch.begin(), batch.end());
+    auto draw = [&]() {
+      render(currentPath, errorMessage);
+      lastDraw = Clock::now();
+      if (timings.firstListing.count() == 0) {
+        recordFirstListing();
+      }
+    };
+
+    // Draw before polling so that the first batch is always on screen before any key is handled
+    if (Clock::now() - lastDraw >= kListingRedrawInterval) {
+      draw();
+    }
+    if (timings.interactive.count() == 0) {
+      timings.interactive = elapsedSinceStart(); // Input is accepted from the first batch on
+    }
+
+    int key = getch();
+    if (key == KEY_UP || key == KEY_DOWN) {
+      handleUserInput(currentPath, key); // Move within the entries listed so far
+      draw();
+    } else if (key != ERR) {
+      interruptKey = key; // Stop listing and let the input loop handle the key
+      return false;
+    }
+    return true;
+  }, &listError);
+  timeout(kInputPollMs);
+
+  if (!listError.empty()) {
+    errorMessage = listError; // Shown in the footer instead of being printed over the screen
+  }
+
+  return interruptKey;
+}
+
+void TUI::recordFirstListing() {
+  timings.firstListing = elapsedSinceStart();
+  if (firstListingCallback) {
+    firstListingCallback();
+  }
+}
+
+void TUI::setFirstListingCallback(std::function<void()> callback) {
+  firstListingCallback = std::move(callback);
+}
+
+std::chrono::microseconds TUI::elapsedSinceStart() const {
+  return std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - runStartTime);
 }
 
 void TUI::displayDirectory(const std::string& currentPath) {
@@ -92,7 +225,8 @@ void TUI::displayDirectory(const std::string& currentPath) {
 
   // Render the left pane (directory listings)
   int leftPaneWidth = COLS / 2; // Half the screen width
-  for (size_t i = 0; i < directoryContents.size(); ++i) {
+  int lastRow = LINES - 3; // Rows from here on belong to the footer
+  for (size_t i = 0; i < directoryContents.size() && 3 + static_cast<int>(i) < lastRow; ++i) {
     std::string displayName;
     if (i == 0 && currentPath != "/") {
       // Display ".." for the parent directory
@@ -122,12 +256,26 @@ void TUI::displayDirectory(const std::string& currentPath) {
   // Render the right pane (file details)
   if (selectedIndex < directoryContents.size()) {
     std::string selectedPath = directoryContents[selectedIndex];
-    selectedPath = fs::canonical(selectedPath).string(); // Get the canonical path
+    std::error_code ec;
+    fs::path canonicalPath = fs::canonical(selectedPath, ec); // Get the canonical path
+    if (!ec) {
+      selectedPath = canonicalPath.string();
+    }
     if (FileManager::exists(selectedPath)) {
       attron(COLOR_PAIR(3));
       mvprintw(3, leftPaneWidth + 2, "File Info:");
       mvprintw(4, leftPaneWidth + 2, "Path: %s", selectedPath.c_str());
-      mvprintw(5, leftPaneWidth + 2, "Size: %lu bytes", FileManager::size(selectedPath));
+
+      // Show the size once the background thread has calculated it
+      std::unique_lock<std::mutex> lock(sizeMutex);
+      auto sizeIt = sizeResults.find(selectedPath);
+      if (sizeIt != sizeResults.end()) {
+        mvprintw(5, leftPaneWidth + 2, "Size: %ju bytes", sizeIt->second);
+      } else {
+        lock.unlock();
+        mvprintw(5, leftPaneWidth + 2, "Size: calculating...");
+        requestSize(selectedPath);
+      }
       attroff(COLOR_PAIR(3));
     }
   }
@@ -146,7 +294,7 @@ void TUI::displayFooter(const std::string& errorMessage) {
 
   // Render the legend
   attron(COLOR_PAIR(5)); // Green for the legend
-  mvprintw(bottomRow + 1, 0, "Legend: [UP/DOWN] Navigate  [ENTER] Open  [q] Quit");
+  mvprintw(bottomRow + 1, 0, "Legend: [UP/DOWN] Navigate  [ENTER] Open  [r] Refresh  [q] Quit");
   attroff(COLOR_PAIR(5));
 }
 
@@ -178,5 +326,87 @@ std::string TUI::handleUserInput(const std::string& currentPath, int key) {
   return currentPath; // Return the current path if no navigation occurred
 }
 
+void TUI::startSizeWorker() {
+  if (sizeWorker.joinable()) {
+    return; // Already running
+  }
+
+  std::lock_guard<std::mutex> lock(sizeMutex);
+  stopSizeThread = false;
+  cancelSize = false;
+  sizeWorker = std::thread(&TUI::sizeWorkerLoop, this);
+}
+
+void TUI::stopSizeWorker() {
+  if (!sizeWorker.joinable()) {
+    return; // Not running
+  }
+
+  // Ask the worker to exit and abandon the calculation in progress
+  {
+    std::lock_guard<std::mutex> lock(sizeMutex);
+    stopSizeThread = true;
+    cancelSize = true;
+  }
+  sizeCondition.notify_one();
+  sizeWorker.join();
+}
+
+void TUI::sizeWorkerLoop() {
+  std::unique_lock<std::mutex> lock(sizeMutex);
+  while (true) {
+    // Wait for a request or shutdown
+    sizeCondition.wait(lock, [this]() { return stopSizeThread || !pendingSizePath.empty(); });
+    if (stopSizeThread) {
+      break;
+    }
+
+    activeSizePath = std::move(pendingSizePath);
+    pendingSizePath.clear();
+    lock.unlock();
+
+    // Calculate without holding the lock so the input loop is never blocked
+    std::string error;
+    std::uintmax_t size = FileManager::size(activeSizePath, &cancelSize, &error);
+
+    lock.lock();
+    if (!cancelSize.exchange(false)) {
+      sizeResults[activeSizePath] = size;
+      if (!error.empty()) {
+        sizeError = std::move(error);
+      }
+      sizeUpdated = true;
+    }
+    activeSizePath.clear();
+  }
+}
+
+void TUI::requestSize(const std::string& path) {
+  {
+    std::lock_guard<std::mutex> lock(sizeMutex);
+    if (path == activeSizePath || path == pendingSizePath) {
+      return; // Already being handled
+    }
+
+    // Only the latest selection matters, so drop the calculation for an earlier one
+    pendingSizePath = path;
+    if (!activeSizePath.empty()) {
+      cancelSize = true;
+    }
+  }
+  sizeCondition.notify_one();
+}
+
+bool TUI::takeSizeUpdate(std::string& errorMessage) {
+  std::lock_guard<std::mutex> lock(sizeMutex);
+  bool updated = sizeUpdated;
+  sizeUpdated = false;
+  if (!sizeError.empty()) {
+    errorMessage = std::move(sizeError);
+    sizeError.clear();
+  }
+  return updated;
+}
+
 } // namespace tui
 } // namespace linux_file_manager
\ No newline at end of file
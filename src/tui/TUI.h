@@ -4,6 +4,13 @@
 #include <vector>
 #include <string>
 #include <cstdint>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include <unordered_map>
+#include <functional>
 
 namespace linux_file_manager {
 namespace tui {
@@ -14,6 +21,15 @@ namespace tui {
  */
 class TUI {
 public:
+  /**
+   * @brief Startup milestones measured from the start of run()
+   */
+  struct StartupTimings {
+    std::chrono::microseconds firstFrame{0};   // Interface frame drawn, before the directory is read
+    std::chrono::microseconds firstListing{0}; // First batch of directory entries drawn
+    std::chrono::microseconds interactive{0};  // First time user input is polled, after the first listing is drawn
+  };
+
   /**
    * @brief Construct a new TUI object
    */
@@ -31,6 +47,20 @@ public:
    */
   void run(std::string path);
 
+  /**
+   * @brief Get the startup timings recorded by the last call to run()
+   * @return The startup timings
+   */
+  const StartupTimings& startupTimings() const;
+
+  /**
+   * @brief Set a function to call once the first batch of directory entries has been drawn
+   * @details The callback runs on the input thread, so it may queue keys with ungetch() (used by bench_startup).
+   * @param callback The function to call
+   * @return void
+   */
+  void setFirstListingCallback(std::function<void()> callback);
+
 private:
   // Helper functions
 
@@ -47,6 +77,37 @@ private:
    */
   void displayHeader(const std::string& currentPath);
 
+  /**
+   * @brief Draw the whole interface and refresh the screen
+   * @param currentPath The current directory path
+   * @param errorMessage The error message to display
+   * @return void
+   */
+  void render(const std::string& currentPath, const std::string& errorMessage);
+
+  /**
+   * @brief Read the directory contents, redrawing as batches of entries come in
+   * @details Input is polled between batches: UP/DOWN move within the entries read so far, while any other key
+   * stops the listing so that the input loop can handle it; the listing is then restarted unless the key navigated
+   * away or quit.
+   * @param currentPath The current directory path
+   * @param errorMessage The error message to display, replaced if the directory cannot be read
+   * @return The key that stopped the listing, or ERR if the whole directory was read
+   */
+  int loadDirectory(const std::string& currentPath, std::string& errorMessage);
+
+  /**
+   * @brief Get the time elapsed since run() started
+   * @return The elapsed time
+   */
+  std::chrono::microseconds elapsedSinceStart() const;
+
+  /**
+   * @brief Record the time of the first drawn listing and notify the first-listing callback
+   * @return void
+   */
+  void recordFirstListing();
+
   /**
    * @brief Display the directory
    * @param path The path to the directory
@@ -75,9 +136,56 @@ private:
    */
   std::string handleUserInput(const std::string& currentPath, int key);
 
+  /**
+   * @brief Start the background thread that calculates sizes
+   * @return void
+   */
+  void startSizeWorker();
+
+  /**
+   * @brief Stop the background size thread, cancelling any calculation in progress
+   * @return void
+   */
+  void stopSizeWorker();
+
+  /**
+   * @brief Background loop calculating the size of the most recently requested path
+   * @return void
+   */
+  void sizeWorkerLoop();
+
+  /**
+   * @brief Ask the background thread for the size of a path, replacing any earlier request
+   * @param path The path to the file or directory
+   * @return void
+   */
+  void requestSize(const std::string& path);
+
+  /**
+   * @brief Check whether the background thread has produced a new size since the last call
+   * @param errorMessage Replaced by the error of the last calculation, if it failed
+   * @return True if a new size is available
+   */
+  bool takeSizeUpdate(std::string& errorMessage);
+
   // State variables
   std::vector<std::string> directoryContents; // The names of the files and directories in the current directory
   int selectedIndex; // The index of the selected file or directory
+  StartupTimings timings; // Startup milestones of the last run
+  std::chrono::steady_clock::time_point runStartTime; // When the last run started
+  std::function<void()> firstListingCallback; // Called once the first listing has been drawn
+
+  // Background size calculation
+  std::thread sizeWorker; // Thread calculating sizes off the input loop
+  std::mutex sizeMutex; // Guards the size state below
+  std::condition_variable sizeCondition; // Signals a new request or shutdown to the worker
+  std::string pendingSizePath; // Path waiting to be calculated
+  std::string activeSizePath; // Path currently being calculated
+  std::unordered_map<std::string, std::uintmax_t> sizeResults; // Calculated sizes by path
+  std::string sizeError; // Error of the last calculation, shown in the footer
+  bool sizeUpdated = false; // Whether a new size has been calculated since the last redraw
+  bool stopSizeThread = false; // Whether the worker should exit
+  std::atomic<bool> cancelSize{false}; // Cancels the calculation in progress
 };
 
 } // namespace tui
@@ -0,0 +1,279 @@
+#include "hash.h"
+#include <cstring> // For std::memcpy
+#include <algorithm> // For std::min
+
+namespace linux_file_manager {
+namespace utils {
+
+namespace {
+
+constexpr std::uint64_t kPrime64_1 = 11400714785074694791ULL;
+constexpr std::uint64_t kPrime64_2 = 14029467366897019727ULL;
+constexpr std::uint64_t kPrime64_3 = 1609587929392839161ULL;
+constexpr std::uint64_t kPrime64_4 = 9650029242287828579ULL;
+constexpr std::uint64_t kPrime64_5 = 2870177450012600261ULL;
+
+constexpr std::uint32_t kSha256RoundConstants[64] = {
+  0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+  0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+  0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+  0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+  0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+  0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+  0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+  0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+inline std::uint64_t rotl64(std::uint64_t value, int bits) {
+  return (value << bits) | (value >> (64 - bits));
+}
+
+inline std::uint32_t rotr32(std::uint32_t value, int bits) {
+  return (value >> bits) | (value << (32 - bits));
+}
+
+// Little-endian reads, as used by XXH64
+inline std::uint64_t readLE64(const unsigned char* p) {
+  std::uint64_t value;
+  std::memcpy(&value, p, sizeof(value));
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+  value = __builtin_bswap64(value);
+#endif
+  return value;
+}
+
+inline std::uint32_t readLE32(const unsigned char* p) {
+  std::uint32_t value;
+  std::memcpy(&value, p, sizeof(value));
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+  value = __builtin_bswap32(value);
+#endif
+  return value;
+}
+
+// Big-endian read, as used by SHA-256
+inline std::uint32_t readBE32(const unsigned char* p) {
+  return (static_cast<std::uint32_t>(p[0]) << 24) | (static_cast<std::uint32_t>(p[1]) << 16) |
+         (static_cast<std::uint32_t>(p[2]) << 8) | static_cast<std::uint32_t>(p[3]);
+}
+
+inline std::uint64_t xxhRound(std::uint64_t accumulator, std::uint64_t input) {
+  accumulator += input * kPrime64_2;
+  accumulator = rotl64(accumulator, 31);
+  return accumulator * kPrime64_1;
+}
+
+inline std::uint64_t xxhMergeRound(std::uint64_t accumulator, std::uint64_t value) {
+  accumulator ^= xxhRound(0, value);
+  return accumulator * kPrime64_1 + kPrime64_4;
+}
+
+} // namespace
+
+Xxh64::Xxh64(std::uint64_t seed) : bufferSize(0), totalLength(0), seed(seed) {
+  accumulators[0] = seed + kPrime64_1 + kPrime64_2;
+  accumulators[1] = seed + kPrime64_2;
+  accumulators[2] = seed;
+  accumulators[3] = seed - kPrime64_1;
+}
+
+void Xxh64::update(const void* data, std::size_t length) {
+  const unsigned char* input = static_cast<const unsigned char*>(data);
+  totalLength += length;
+
+  // Complete the partial stripe first
+  if (bufferSize > 0) {
+    std::size_t fill = std::min(length, sizeof(buffer) - bufferSize);
+    std::memcpy(buffer + bufferSize, input, fill);
+    bufferSize += fill;
+    input += fill;
+    length -= fill;
+    if (bufferSize < sizeof(buffer)) {
+      return; // Still not a full stripe
+    }
+    for (int lane = 0; lane < 4; ++lane) {
+      accumulators[lane] = xxhRound(accumulators[lane], readLE64(buffer + lane * 8));
+    }
+    bufferSize = 0;
+  }
+
+  // Process whole stripes directly from the input
+  std::uint64_t v1 = accumulators[0], v2 = accumulators[1], v3 = accumulators[2], v4 = accumulators[3];
+  while (length >= 32) {
+    v1 = xxhRound(v1, readLE64(input));
+    v2 = xxhRound(v2, readLE64(input + 8));
+    v3 = xxhRound(v3, readLE64(input + 16));
+    v4 = xxhRound(v4, readLE64(input + 24));
+    input += 32;
+    length -= 32;
+  }
+  accumulators[0] = v1;
+  accumulators[1] = v2;
+  accumulators[2] = v3;
+  accumulators[3] = v4;
+
+  // Keep the remainder for the next update
+  std::memcpy(buffer, input, length);
+  bufferSize = length;
+}
+
+std::uint64_t Xxh64::digest() const {
+  std::uint64_t hash;
+  if (totalLength >= 32) {
+    hash = rotl64(accumulators[0], 1) + rotl64(accumulators[1], 7) + rotl64(accumulators[2], 12) +
+           rotl64(accumulators[3], 18);
+    for (int lane = 0; lane < 4; ++lane) {
+      hash = xxhMergeRound(hash, accumulators[lane]);
+    }
+  } else {
+    hash = seed + kPrime64_5;
+  }
+  hash += totalLength;
+
+  // Mix in the bytes that did not fill a stripe
+  const unsigned char* p = buffer;
+  std::size_t remaining = bufferSize;
+  while (remaining >= 8) {
+    hash ^= xxhRound(0, readLE64(p));
+    hash = rotl64(hash, 27) * kPrime64_1 + kPrime64_4;
+    p += 8;
+    remaining -= 8;
+  }
+  if (remaining >= 4) {
+    hash ^= static_cast<std::uint64_t>(readLE32(p)) * kPrime64_1;
+    hash = rotl64(hash, 23) * kPrime64_2 + kPrime64_3;
+    p += 4;
+    remaining -= 4;
+  }
+  while (remaining > 0) {
+    hash ^= static_cast<std::uint64_t>(*p) * kPrime64_5;
+    hash = rotl64(hash, 11) * kPrime64_1;
+    ++p;
+    --remaining;
+  }
+
+  // Final avalanche
+  hash ^= hash >> 33;
+  hash *= kPrime64_2;
+  hash ^= hash >> 29;
+  hash *= kPrime64_3;
+  hash ^= hash >> 32;
+  return hash;
+}
+
+Sha256::Sha256() : bufferSize(0), totalLength(0) {
+  state[0] = 0x6a09e667;
+  state[1] = 0xbb67ae85;
+  state[2] = 0x3c6ef372;
+  state[3] = 0xa54ff53a;
+  state[4] = 0x510e527f;
+  state[5] = 0x9b05688c;
+  state[6] = 0x1f83d9ab;
+  state[7] = 0x5be0cd19;
+}
+
+void Sha256::update(const void* data, std::size_t length) {
+  const unsigned char* input = static_cast<const unsigned char*>(data);
+  totalLength += length;
+
+  // Complete the partial block first
+  if (bufferSize > 0) {
+    std::size_t fill = std::min(length, sizeof(buffer) - bufferSize);
+    std::memcpy(buffer + bufferSize, input, fill);
+    bufferSize += fill;
+    input += fill;
+    length -= fill;
+    if (bufferSize < sizeof(buffer)) {
+      return; // Still not a full block
+    }
+    transform(buffer);
+    bufferSize = 0;
+  }
+
+  // Process whole blocks directly from the input
+  while (length >= 64) {
+    transform(input);
+    input += 64;
+    length -= 64;
+  }
+
+  // Keep the remainder for the next update
+  std::memcpy(buffer, input, length);
+  bufferSize = length;
+}
+
+std::string Sha256::hexDigest() {
+  // Pad with 0x80, zeros and the message length in bits
+  std::uint64_t bitLength = totalLength * 8;
+  unsigned char padding[72] = {0x80};
+  std::size_t paddingSize = (bufferSize < 56 ? 56 : 120) - bufferSize;
+  update(padding, paddingSize);
+  unsigned char lengthBytes[8];
+  for (int i = 0; i < 8; ++i) {
+    lengthBytes[i] = static_cast<unsigned char>(bitLength >> (56 - 8 * i));
+  }
+  update(lengthBytes, sizeof(lengthBytes));
+
+  static const char digits[] = "0123456789abcdef";
+  std::string hex;
+  hex.reserve(64);
+  for (std::uint32_t word : state) {
+    for (int shift = 28; shift >= 0; shift -= 4) {
+      hex.push_back(digits[(word >> shift) & 0xf]);
+    }
+  }
+  return hex;
+}
+
+void Sha256::transform(const unsigned char* block) {
+  std::uint32_t w[64];
+  for (int i = 0; i < 16; ++i) {
+    w[i] = readBE32(block + i * 4);
+  }
+  for (int i = 16; i < 64; ++i) {
+    std::uint32_t s0 = rotr32(w[i - 15], 7) ^ rotr32(w[i - 15], 18) ^ (w[i - 15] >> 3);
+    std::uint32_t s1 = rotr32(w[i - 2], 17) ^ rotr32(w[i - 2], 19) ^ (w[i - 2] >> 10);
+    w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+  }
+
+  std::uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+  std::uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+  for (int i = 0; i < 64; ++i) {
+    std::uint32_t s1 = rotr32(e, 6) ^ rotr32(e, 11) ^ rotr32(e, 25);
+    std::uint32_t choice = (e & f) ^ (~e & g);
+    std::uint32_t temp1 = h + s1 + choice + kSha256RoundConstants[i] + w[i];
+    std::uint32_t s0 = rotr32(a, 2) ^ rotr32(a, 13) ^ rotr32(a, 22);
+    std::uint32_t majority = (a & b) ^ (a & c) ^ (b & c);
+    std::uint32_t temp2 = s0 + majority;
+    h = g;
+    g = f;
+    f = e;
+    e = d + temp1;
+    d = c;
+    c = b;
+    b = a;
+    a = temp1 + temp2;
+  }
+
+  state[0] += a;
+  state[1] += b;
+  state[2] += c;
+  state[3] += d;
+  state[4] += e;
+  state[5] += f;
+  state[6] += g;
+  state[7] += h;
+}
+
+std::string toHex(std::uint64_t hash) {
+  static const char digits[] = "0123456789abcdef";
+  std::string hex(16, '0');
+  for (int i = 15; i >= 0; --i) {
+    hex[i] = digits[hash & 0xf];
+    hash >>= 4;
+  }
+  return hex;
+}
+
+} // namespace utils
+} // namespace linux_file_manager
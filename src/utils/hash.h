@@ -0,0 +1,94 @@
+#ifndef HASH_H
+#define HASH_H
+
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+namespace linux_file_manager {
+namespace utils {
+
+/**
+ * @brief Streaming XXH64 hash
+ * @details A fast non-cryptographic 64-bit hash, compatible with the reference xxHash XXH64 implementation.
+ */
+class Xxh64 {
+public:
+  /**
+   * @brief Construct a new Xxh64 object
+   * @param seed The hash seed
+   */
+  explicit Xxh64(std::uint64_t seed = 0);
+
+  /**
+   * @brief Add data to the hash
+   * @param data The data to add
+   * @param length The number of bytes to add
+   * @return void
+   */
+  void update(const void* data, std::size_t length);
+
+  /**
+   * @brief Get the hash of all data added so far
+   * @return The 64-bit hash
+   */
+  std::uint64_t digest() const;
+
+private:
+  std::uint64_t accumulators[4]; // Lane accumulators
+  unsigned char buffer[32];      // Partial stripe
+  std::size_t bufferSize;        // Bytes in the partial stripe
+  std::uint64_t totalLength;     // Total bytes added
+  std::uint64_t seed;            // Hash seed
+};
+
+/**
+ * @brief Streaming SHA-256 hash
+ */
+class Sha256 {
+public:
+  /**
+   * @brief Construct a new Sha256 object
+   */
+  Sha256();
+
+  /**
+   * @brief Add data to the hash
+   * @param data The data to add
+   * @param length The number of bytes to add
+   * @return void
+   */
+  void update(const void* data, std::size_t length);
+
+  /**
+   * @brief Finish the hash
+   * @details The object must not be updated after this call.
+   * @return The hash as a lowercase hex string
+   */
+  std::string hexDigest();
+
+private:
+  /**
+   * @brief Process one 64-byte block
+   * @param block The block to process
+   * @return void
+   */
+  void transform(const unsigned char* block);
+
+  std::uint32_t state[8];    // Intermediate hash value
+  unsigned char buffer[64];  // Partial block
+  std::size_t bufferSize;    // Bytes in the partial block
+  std::uint64_t totalLength; // Total bytes added
+};
+
+/**
+ * @brief A function to format a 64-bit hash as a hex string
+ * @param hash The hash to format
+ * @return The hash as a 16-character lowercase hex string
+ */
+std::string toHex(std::uint64_t hash);
+
+} // namespace utils
+} // namespace linux_file_manager
+
+#endif // HASH_H
@@ -1,69 +1,156 @@
 #include "utils.h"
 #include <fstream> // For file I/O
 #include <iostream> // For error reporting
+#include <cstdlib> // For std::getenv
+#include <cstdio> // For std::rename and std::remove
+#include <algorithm> // For std::equal
+#include <unistd.h> // For getpid
 
 namespace linux_file_manager {
 namespace utils {
 
-std::unordered_map<std::string, SizeCache> loadSizeCache(const std::string& path) {
+// Identifies a size cache file and its format version
+constexpr char kSizeCacheMagic[8] = {'L', 'F', 'M', 'S', 'Z', 'C', '0', '1'};
+
+// Hand an error message to the caller if it asked for one, otherwise print it
+static void reportError(std::string* error, const std::string& message) {
+  if (error) {
+    *error = message;
+  } else {
+    std::cerr << message << std::endl;
+  }
+}
+
+std::unordered_map<std::string, SizeCache> loadSizeCache(const std::string& path, std::string* error) {
   std::unordered_map<std::string, SizeCache> cache;
 
   // Open the file in binary read mode
-  std::ifstream inFile(path, std::ios::binary);
+  std::ifstream inFile(path, std::ios::binary | std::ios::ate);
   if (!inFile) {
-    std::cerr << "Cache file not found or unreadable: " << path << std::endl;
+    reportError(error, "Cache file not found or unreadable: " + path);
+    return cache;
+  }
+  std::uintmax_t remaining = static_cast<std::uintmax_t>(inFile.tellg()); // Bytes left to read
+  inFile.seekg(0);
+
+  // Read a field, failing if the file is shorter than expected
+  auto readBytes = [&](char* data, std::size_t size) {
+    if (size > remaining || !inFile.read(data, size)) {
+      return false;
+    }
+    remaining -= size;
+    return true;
+  };
+
+  // Check the magic and version
+  char magic[sizeof(kSizeCacheMagic)];
+  if (!readBytes(magic, sizeof(magic)) || !std::equal(magic, magic + sizeof(magic), kSizeCacheMagic)) {
+    reportError(error, "Ignoring size cache with unknown format: " + path);
     return cache;
   }
 
   size_t numEntries = 0;
-  inFile.read(reinterpret_cast<char*>(&numEntries), sizeof(numEntries)); // Read the number of entries
+  if (!readBytes(reinterpret_cast<char*>(&numEntries), sizeof(numEntries))) { // Read the number of entries
+    reportError(error, "Ignoring truncated size cache: " + path);
+    return cache;
+  }
+
+  // Each entry needs at least its path length, size and time, so a larger count cannot be valid
+  std::chrono::system_clock::duration duration;
+  const std::uintmax_t minEntrySize = sizeof(size_t) + sizeof(SizeCache::size) + sizeof(duration);
+  if (numEntries > remaining / minEntrySize) {
+    reportError(error, "Ignoring corrupt size cache: " + path);
+    return cache;
+  }
 
   for (size_t i = 0; i < numEntries; ++i) {
     size_t pathSize = 0;
-    inFile.read(reinterpret_cast<char*>(&pathSize), sizeof(pathSize)); // Read the size of the path string
-
-    std::string path(pathSize, '\0');
-    inFile.read(&path[0], pathSize); // Read the path string
+    if (!readBytes(reinterpret_cast<char*>(&pathSize), sizeof(pathSize)) || // Read the size of the path string
+        pathSize > remaining) {
+      cache.clear(); // Discard the whole file on any mismatch
+      break;
+    }
 
+    std::string entryPath(pathSize, '\0');
     SizeCache entry;
-    inFile.read(reinterpret_cast<char*>(&entry.size), sizeof(entry.size)); // Read the cached size
-
-    // Read the file time as a duration
-    std::chrono::system_clock::duration duration;
-    inFile.read(reinterpret_cast<char*>(&duration), sizeof(duration));
+    if (!readBytes(&entryPath[0], pathSize) || // Read the path string
+        !readBytes(reinterpret_cast<char*>(&entry.size), sizeof(entry.size)) || // Read the cached size
+        !readBytes(reinterpret_cast<char*>(&duration), sizeof(duration))) { // Read the file time as a duration
+      cache.clear();
+      break;
+    }
     entry.time = std::filesystem::file_time_type(duration);
 
-    cache[path] = entry; // Add to the cache
+    cache[entryPath] = entry; // Add to the cache
+  }
+
+  if (cache.size() != numEntries || remaining != 0) {
+    reportError(error, "Ignoring corrupt size cache: " + path);
+    cache.clear();
   }
 
-  inFile.close();
   return cache;
 }
 
-void saveSizeCache(const std::string& path, const std::unordered_map<std::string, SizeCache>& cache) {
-  // Open the file in binary write mode
-  std::ofstream outFile(path, std::ios::binary);
-  if (!outFile) {
-    std::cerr << "Failed to open cache file for writing: " << path << std::endl;
-    return;
+bool saveSizeCache(const std::string& path, const std::unordered_map<std::string, SizeCache>& cache, std::string* error) {
+  // Write to a temporary file next to the cache and rename it over the cache, so that a crash or another
+  // instance exiting at the same time never leaves a partially written cache behind
+  std::string tempPath = path + ".tmp." + std::to_string(getpid());
+
+  {
+    // Open the file in binary write mode
+    std::ofstream outFile(tempPath, std::ios::binary);
+    if (!outFile) {
+      reportError(error, "Failed to open cache file for writing: " + tempPath);
+      return false;
+    }
+
+    outFile.write(kSizeCacheMagic, sizeof(kSizeCacheMagic)); // Write the magic and version
+
+    size_t numEntries = cache.size();
+    outFile.write(reinterpret_cast<const char*>(&numEntries), sizeof(numEntries)); // Write the number of entries
+
+    for (const auto& [key, entry] : cache) {
+      size_t pathSize = key.size();
+      outFile.write(reinterpret_cast<const char*>(&pathSize), sizeof(pathSize)); // Write the size of the path string
+      outFile.write(key.data(), pathSize); // Write the path string
+
+      outFile.write(reinterpret_cast<const char*>(&entry.size), sizeof(entry.size)); // Write the cached size
+
+      // Write the file time as a duration
+      auto duration = entry.time.time_since_epoch();
+      outFile.write(reinterpret_cast<const char*>(&duration), sizeof(duration));
+    }
+
+    outFile.close();
+    if (!outFile) {
+      reportError(error, "Failed to write cache file: " + tempPath);
+      std::remove(tempPath.c_str());
+      return false;
+    }
   }
 
-  size_t numEntries = cache.size();
-  outFile.write(reinterpret_cast<const char*>(&numEntries), sizeof(numEntries)); // Write the number of entries
-
-  for (const auto& [key, entry] : cache) {
-    size_t pathSize = key.size();
-    outFile.write(reinterpret_cast<const char*>(&pathSize), sizeof(pathSize)); // Write the size of the path string
-    outFile.write(key.data(), pathSize); // Write the path string
+  if (std::rename(tempPath.c_str(), path.c_str()) != 0) {
+    reportError(error, "Failed to replace cache file: " + path);
+    std::remove(tempPath.c_str());
+    return false;
+  }
+  return true;
+}
 
-    outFile.write(reinterpret_cast<const char*>(&entry.size), sizeof(entry.size)); // Write the cached size
+std::string defaultSizeCachePath() {
+  std::filesystem::path cacheDir;
 
-    // Write the file time as a duration
-    auto duration = entry.time.time_since_epoch();
-    outFile.write(reinterpret_cast<const char*>(&duration), sizeof(duration));
+  // Prefer the XDG cache directory, falling back to ~/.cache
+  if (const char* xdgCache = std::getenv("XDG_CACHE_HOME"); xdgCache && *xdgCache) {
+    cacheDir = xdgCache;
+  } else if (const char* home = std::getenv("HOME"); home && *home) {
+    cacheDir = std::filesystem::path(home) / ".cache";
+  } else {
+    return ""; // No cache directory available
   }
 
-  outFile.close();
+  return (cacheDir / "linux_file_manager" / "size_cache.bin").string();
 }
 
 } // namespace utils
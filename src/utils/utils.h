@@ -21,18 +21,30 @@ struct SizeCache {
 
 /**
  * @brief A function to load the size cache from a file
+ * @details The whole file is ignored if its header, entry count or any entry does not match its contents.
  * @param path The path to the file to load the cache from
- * @return The cache object
+ * @param error If not null, receives the error message instead of it being printed
+ * @return The cache object, empty if the file is missing or corrupt
  */
-std::unordered_map<std::string, SizeCache> loadSizeCache(const std::string& path);
+std::unordered_map<std::string, SizeCache> loadSizeCache(const std::string& path, std::string* error = nullptr);
 
 /**
  * @brief A function to save the size cache to a file
+ * @details The cache is written to a temporary file that then replaces the old cache atomically.
  * @param path The path to the file to save the cache to
  * @param cache The cache object to save
- * @return void
+ * @param error If not null, receives the error message instead of it being printed
+ * @return True if the cache was saved successfully, false otherwise
  */
-void saveSizeCache(const std::string& path, const std::unordered_map<std::string, SizeCache>& cache);
+bool saveSizeCache(const std::string& path, const std::unordered_map<std::string, SizeCache>& cache,
+                   std::string* error = nullptr);
+
+/**
+ * @brief A function to get the default location of the size cache file
+ * @details Uses $XDG_CACHE_HOME if set, otherwise $HOME/.cache
+ * @return The path to the cache file, or an empty string if no cache directory is available
+ */
+std::string defaultSizeCachePath();
 
 } // namespace utils
 } // namespace linux_file_manager
@@ -0,0 +1,309 @@
+/**
+ * @file test_Checksum.cpp
+ * @brief Tests for the hash functions, the manifest format and verifying a tree against a manifest.
+ *
+ * The expected hashes come from the reference xxHash library and sha256sum. The chunk-boundary files pin down
+ * the tree hash, so a change to the chunking that would invalidate existing manifests fails here.
+ */
+
+#include <iostream> // for reporting failures
+#include <fstream> // for writing test files
+#include <sstream> // for manifests in memory
+#include <filesystem> // for the temporary tree
+#include <string> // for std::string
+#include <vector> // for std::vector
+#include <utility> // for std::pair
+#include <chrono> // for moving mtimes
+#include <unistd.h> // for getpid and geteuid
+
+#include "../src/core/Checksum.h" // include the Checksum class
+#include "../src/core/FileManager.h" // include the FileManager class
+#include "../src/utils/hash.h" // include the hash functions
+
+namespace fs = std::filesystem;
+namespace core = linux_file_manager::core;
+namespace utils = linux_file_manager::utils;
+
+static int failures = 0;
+
+// Compare a result with the expected value and report a mismatch
+static void expectEqual(const std::string& actual, const std::string& expected, const std::string& what) {
+  if (actual != expected) {
+    std::cerr << "FAIL " << what << ": got " << actual << ", expected " << expected << std::endl;
+    ++failures;
+  }
+}
+
+// Check a condition and report it if it does not hold
+static void expectTrue(bool condition, const std::string& what) {
+  if (!condition) {
+    std::cerr << "FAIL " << what << std::endl;
+    ++failures;
+  }
+}
+
+// Compare a list of paths with the expected one
+static void expectPaths(const std::vector<std::string>& actual, const std::vector<std::string>& expected,
+                        const std::string& what) {
+  std::string actualText, expectedText;
+  for (const auto& path : actual) {
+    actualText += "[" + path + "]";
+  }
+  for (const auto& path : expected) {
+    expectedText += "[" + path + "]";
+  }
+  expectEqual(actualText, expectedText, what);
+}
+
+// Create an empty temporary directory for one test
+static fs::path makeTempTree(const std::string& name) {
+  fs::path root = fs::temp_directory_path() / ("lfm_test_" + name + "_" + std::to_string(getpid()));
+  fs::remove_all(root);
+  fs::create_directories(root);
+  return root;
+}
+
+// Create or replace a file with the given contents
+static void writeFile(const fs::path& path, const std::string& data) {
+  std::ofstream(path, std::ios::binary).write(data.data(), data.size());
+}
+
+// Deterministic test content
+static std::string pattern(std::size_t size) {
+  std::string data(size, '\0');
+  for (std::size_t i = 0; i < size; ++i) {
+    data[i] = static_cast<char>((i * 131 + 7) & 0xff);
+  }
+  return data;
+}
+
+static std::string xxh64(const std::string& data) {
+  utils::Xxh64 hash;
+  hash.update(data.data(), data.size());
+  return utils::toHex(hash.digest());
+}
+
+static std::string sha256(const std::string& data) {
+  utils::Sha256 hash;
+  hash.update(data.data(), data.size());
+  return hash.hexDigest();
+}
+
+static void testXxh64() {
+  expectEqual(xxh64(""), "ef46db3751d8e999", "XXH64(\"\")");
+  expectEqual(xxh64("abc"), "44bc2cf5ad770999", "XXH64(\"abc\")");
+  expectEqual(xxh64(pattern(100)), "9ddada11d3dc2d8f", "XXH64(pattern 100)");
+
+  // Feeding the input in uneven pieces must not change the result
+  std::string data = pattern(100);
+  utils::Xxh64 hash;
+  hash.update(data.data(), 7);
+  hash.update(data.data() + 7, 30);
+  hash.update(data.data() + 37, 63);
+  expectEqual(utils::toHex(hash.digest()), "9ddada11d3dc2d8f", "XXH64(pattern 100) in pieces");
+}
+
+static void testSha256() {
+  expectEqual(sha256(""), "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855", "SHA-256(\"\")");
+  expectEqual(sha256("abc"), "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad", "SHA-256(\"abc\")");
+  expectEqual(sha256("abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq"),
+              "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1", "SHA-256(56 bytes)");
+  expectEqual(sha256(std::string(1000000, 'a')),
+              "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0", "SHA-256(1,000,000 x 'a')");
+}
+
+static void testTreeHash() {
+  // One file of exactly one chunk, hashed directly, and one a byte longer, hashed as a tree of two chunks
+  fs::path root = makeTempTree("checksum");
+  std::string data = pattern(core::Checksum::kChunkSize + 1);
+  writeFile(root / "exact", data.substr(0, core::Checksum::kChunkSize));
+  writeFile(root / "plus1", data);
+
+  // Large files are read in parallel chunks without SHA-256 and sequentially with it; both must agree
+  for (bool withSha256 : {false, true}) {
+    core::ChecksumOptions options;
+    options.sha256 = withSha256;
+    core::ChecksumStats stats;
+    auto manifest = core::Checksum::hashTree(root.string(), options, stats);
+    std::string mode = withSha256 ? " (sequential)" : " (chunked)";
+
+    if (manifest.size() != 2 || stats.errors != 0) {
+      std::cerr << "FAIL hashTree" << mode << ": expected 2 files and no errors" << std::endl;
+      ++failures;
+      continue;
+    }
+    expectEqual(manifest[0].path, "exact", "manifest order");
+    expectEqual(utils::toHex(manifest[0].fastHash), "139a28963f6afc74", "fast hash of kChunkSize bytes" + mode);
+    expectEqual(utils::toHex(manifest[1].fastHash), "3ab9f0f5d0c02436", "fast hash of kChunkSize+1 bytes" + mode);
+    if (withSha256) {
+      expectEqual(manifest[0].sha256, "8cabacff88558f4e865aa9a7f77dfa3fb7de24a2142d4b017a959b39b228498a",
+                  "SHA-256 of kChunkSize bytes");
+      expectEqual(manifest[1].sha256, "628bf9f8d10ec9dbdb01a003ffe20202eb16b80862d061a7abeb7959d0b6cc39",
+                  "SHA-256 of kChunkSize+1 bytes");
+    }
+  }
+
+  fs::remove_all(root);
+}
+
+static void testVerify() {
+  fs::path root = makeTempTree("verify");
+  fs::create_directories(root / "dir");
+  writeFile(root / "same", "unchanged");
+  writeFile(root / "rewritten", "12345");
+  writeFile(root / "resized", "12345");
+  writeFile(root / "touched", "12345");
+  writeFile(root / "dir" / "removed", "gone soon");
+
+  core::ChecksumOptions options;
+  core::ChecksumStats stats;
+  auto manifest = core::Checksum::hashTree(root.string(), options, stats);
+  expectTrue(manifest.size() == 5 && stats.errors == 0, "hashTree of the verify tree");
+
+  // An untouched tree is accepted without rereading anything
+  auto report = core::Checksum::verifyTree(root.string(), manifest, options, stats);
+  expectTrue(report.ok() && report.unchanged == 5 && report.matched == 0, "verify skips unchanged files");
+  expectTrue(stats.files == 0, "verify reads no unchanged file");
+
+  // A rewrite that keeps the size and mtime is only noticed with a full verify
+  auto mtime = fs::last_write_time(root / "rewritten");
+  writeFile(root / "rewritten", "54321");
+  fs::last_write_time(root / "rewritten", mtime);
+  report = core::Checksum::verifyTree(root.string(), manifest, options, stats);
+  expectTrue(report.ok() && report.unchanged == 5, "verify trusts an unchanged size and mtime");
+
+  core::ChecksumOptions full;
+  full.full = true;
+  report = core::Checksum::verifyTree(root.string(), manifest, full, stats);
+  expectPaths(report.modified, {"rewritten"}, "full verify finds a rewrite with the same size and mtime");
+  expectTrue(report.matched == 4 && report.unchanged == 0, "full verify rehashes every file");
+
+  // Changed size, changed mtime with the same contents, and removed and added files
+  writeFile(root / "resized", "123456");
+  fs::last_write_time(root / "touched", mtime + std::chrono::seconds(10));
+  fs::remove(root / "dir" / "removed");
+  writeFile(root / "dir" / "added", "new");
+  report = core::Checksum::verifyTree(root.string(), manifest, options, stats);
+  expectPaths(report.modified, {"resized"}, "modified files");
+  expectPaths(report.missing, {"dir/removed"}, "missing files");
+  expectPaths(report.added, {"dir/added"}, "added files");
+  expectTrue(report.unreadable.empty(), "no unreadable files");
+  expectTrue(report.matched == 1 && report.unchanged == 2, "a touched file is rehashed and matches");
+  expectTrue(!report.ok(), "a changed tree is not ok");
+
+  // A tree that cannot be read at all is reported once instead of as missing files
+  report = core::Checksum::verifyTree((root / "absent").string(), manifest, options, stats);
+  expectPaths(report.unreadable, {"."}, "unreadable root");
+  expectTrue(report.missing.empty() && stats.errors == 1, "no missing files below an unreadable root");
+
+  // Permissions do not apply to root, so an unreadable directory can only be tested as another user
+  if (geteuid() != 0) {
+    fs::create_directories(root / "locked");
+    writeFile(root / "locked" / "secret", "hidden");
+    manifest = core::Checksum::hashTree(root.string(), options, stats);
+    fs::permissions(root / "locked", fs::perms::none);
+    report = core::Checksum::verifyTree(root.string(), manifest, options, stats);
+    fs::permissions(root / "locked", fs::perms::owner_all);
+    expectPaths(report.unreadable, {"locked"}, "unreadable directory");
+    expectTrue(report.missing.empty(), "no missing files below an unreadable directory");
+  }
+
+  // The manifest is left out of the tree it is stored in
+  writeFile(root / "MANIFEST", "# stands in for the manifest");
+  options.exclude.push_back((root / "." / "MANIFEST").string());
+  manifest = core::Checksum::hashTree(root.string(), options, stats);
+  report = core::Checksum::verifyTree(root.string(), manifest, options, stats);
+  expectTrue(report.ok(), "verify against a manifest stored in the tree");
+  for (const auto& entry : manifest) {
+    expectTrue(entry.path != "MANIFEST", "excluded file is not hashed");
+  }
+
+  fs::remove_all(root);
+}
+
+static void testManifestFormat() {
+  // Paths with the characters that need escaping survive a round trip
+  std::vector<core::ManifestEntry> entries(3);
+  entries[0].path = "back\\slash";
+  entries[0].size = 1;
+  entries[0].mtime = 1700000000123456789;
+  entries[0].fastHash = 0x0123456789abcdefULL;
+  entries[1].path = "new\nline";
+  entries[1].sha256 = sha256("abc");
+  entries[2].path = " leading space";
+  entries[2].size = 42;
+  entries[2].fastHash = 0xfedcba9876543210ULL;
+
+  std::stringstream manifest;
+  expectTrue(core::Checksum::writeManifest(manifest, entries), "writeManifest");
+  std::vector<core::ManifestEntry> read;
+  expectTrue(core::Checksum::readManifest(manifest, read), "readManifest of a written manifest");
+  expectTrue(read.size() == entries.size(), "round trip keeps every entry");
+  for (std::size_t i = 0; i < read.size() && i < entries.size(); ++i) {
+    expectEqual(read[i].path, entries[i].path, "round trip of path " + std::to_string(i));
+    expectEqual(read[i].sha256, entries[i].sha256, "round trip of SHA-256 " + std::to_string(i));
+    expectTrue(read[i].size == entries[i].size && read[i].mtime == entries[i].mtime &&
+               read[i].fastHash == entries[i].fastHash, "round trip of size, mtime and hash " + std::to_string(i));
+  }
+
+  // Malformed hashes and repeated paths are rejected
+  const std::string header = "# lfm-manifest 1 xxh64-tree " + std::to_string(core::Checksum::kChunkSize) + "\n";
+  const std::string line = "0123456789abcdef - 1 2 file\n";
+  const std::pair<std::string, std::string> invalid[] = {
+    {"short fast hash", "0123456789abcde - 1 2 file\n"},
+    {"uppercase fast hash", "0123456789ABCDEF - 1 2 file\n"},
+    {"short SHA-256", "0123456789abcdef abc 1 2 file\n"},
+    {"uppercase SHA-256", "0123456789abcdef " + std::string(64, 'A') + " 1 2 file\n"},
+    {"duplicate path", line + line},
+  };
+  for (const auto& [what, body] : invalid) {
+    std::istringstream in(header + body);
+    expectTrue(!core::Checksum::readManifest(in, read), "readManifest rejects a " + what);
+  }
+  std::istringstream valid(header + line + "0123456789abcdef " + std::string(64, 'a') + " 1 2 other\n");
+  expectTrue(core::Checksum::readManifest(valid, read) && read.size() == 2, "readManifest accepts valid entries");
+}
+
+static void testWalkErrors() {
+  fs::path root = makeTempTree("walk");
+  fs::create_directories(root / "dir");
+  writeFile(root / "dir" / "file", "data");
+
+  std::vector<std::string> files, errors;
+  auto onFile = [&](const std::string& path) { files.push_back(path); };
+  auto onError = [&](const std::string& path, const std::string&) { errors.push_back(path); };
+  expectTrue(core::FileManager::walk(root.string(), onFile, onError), "walk of a readable tree");
+  expectPaths(files, {(root / "dir" / "file").string()}, "walk visits every file");
+  expectTrue(errors.empty(), "walk of a readable tree reports no errors");
+
+  files.clear();
+  expectTrue(!core::FileManager::walk((root / "absent").string(), onFile, onError), "walk of a missing tree");
+  expectPaths(errors, {(root / "absent").string()}, "walk reports a missing tree");
+
+  // Permissions do not apply to root, so an unreadable directory can only be tested as another user
+  if (geteuid() != 0) {
+    errors.clear();
+    fs::permissions(root / "dir", fs::perms::none);
+    expectTrue(!core::FileManager::walk(root.string(), onFile, onError), "walk of a tree with a locked directory");
+    fs::permissions(root / "dir", fs::perms::owner_all);
+    expectPaths(errors, {(root / "dir").string()}, "walk reports a locked directory");
+  }
+
+  fs::remove_all(root);
+}
+
+int main() {
+  testXxh64();
+  testSha256();
+  testTreeHash();
+  testVerify();
+  testManifestFormat();
+  testWalkErrors();
+
+  if (failures > 0) {
+    std::cerr << failures << " checks failed" << std::endl;
+    return 1;
+  }
+  std::cout << "All checksum tests passed" << std::endl;
+  return 0;
+}